@@ -0,0 +1,18 @@
+QT += widgets network concurrent
+CONFIG += c++11
+TARGET = basicdrawing
+
+HEADERS       = renderarea.h \
+                window.h \
+    boardfacory.h \
+    placer.h \
+    layout.h \
+    headless.h \
+    layoutserver.h
+SOURCES       = main.cpp \
+                renderarea.cpp \
+                layout.cpp \
+                headless.cpp \
+                layoutserver.cpp \
+                window.cpp
+
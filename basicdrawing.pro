@@ -1,10 +1,5 @@
-QT += widgets
-CONFIG += c++11
-
-HEADERS       = renderarea.h \
-                window.h \
-    boardfacory.h
-SOURCES       = main.cpp \
-                renderarea.cpp \
-                window.cpp
+# aplikacia a testy kladenia, make check spusti tests/tst_layout
+TEMPLATE = subdirs
+SUBDIRS = app tests
 
+app.file = app.pro
@@ -1,7 +1,7 @@
 #pragma once
 
+#include<algorithm>
 #include<memory>
-#include<stack>
 
 struct Board;
 
@@ -47,38 +47,124 @@ struct Board
 
       return BoardPtr(tail);
   }
+
+  bool operator==(const Board& o) const
+  {
+      return len == o.len && width == o.width
+              && cutH == o.cutH && cutT == o.cutT
+              && cutL == o.cutL && cutR == o.cutR;
+  }
 };
 
 class BoardFactory
 {
-    std::stack<BoardPtr> stack;
-    int count = 74;
   public:
+    // odrezky su nemenny zretazeny zoznam, snapshot si len zdiela vrchol
+    struct Offcut
+    {
+        Board board;
+        std::shared_ptr<const Offcut> next;
+        size_t depth;
+    };
+    using OffcutPtr = std::shared_ptr<const Offcut>;
+
+  private:
+    OffcutPtr stack;
+    Board full;
+    int stock;
+    int count;
+    int allocs = 0;
+    size_t deepest = 0;
+  public:
+    static constexpr double firstCut = 1500;    // o tolko je kratsia prva doska
+
+    explicit BoardFactory(int stock = 74, const Board& board = Board())
+        :full(board)
+        ,stock(stock)
+        ,count(stock)
+    {}
+
+    const Board& fullBoard() const { return full; }
+
+    // stav skladu (odrezky + pocet celych dosiek) pred/po riadku,
+    // podla neho sa pri lokalnom preskladani zisti, ci sa dalsi riadok zmeni
+    struct Snapshot
+    {
+        OffcutPtr stack;
+        int count = 0;
+
+        size_t depth() const { return stack ? stack->depth : 0; }
+
+        bool operator==(const Snapshot& o) const
+        {
+            if(count != o.count || depth() != o.depth())
+                return false;
+            // od spolocneho uzla su zoznamy zhodne
+            for(auto a = stack.get(), b = o.stack.get(); a != b;
+                a = a->next.get(), b = b->next.get())
+            {
+                if(!(a->board == b->board))
+                    return false;
+            }
+            return true;
+        }
+        bool operator!=(const Snapshot& o) const { return !(*this == o); }
+    };
+
+    Snapshot snapshot() const
+    {
+        Snapshot rv;
+        rv.stack = stack;
+        rv.count = count;
+        return rv;
+    }
+
+    void restore(const Snapshot& s)
+    {
+        count = s.count;
+        stack = s.stack;
+        deepest = depth();
+    }
+
     BoardPtr aquire()
     {
-        if(!stack.empty()){
-            auto rv = std::move(stack.top());
-            stack.pop();
+        if(stack){
+            allocs++;
+            BoardPtr rv(new Board(stack->board));
+            stack = stack->next;
             return rv;
         }
 
-        if(count == 74){
-            count--;
-            auto rv = new Board;
-            rv->len -= 1500;
-            return BoardPtr(rv);
+        if(count <= 0){
+            qCritical() << "no more boards";
+            return nullptr;
         }
 
-        if(count--){
-            return BoardPtr(new Board);
-        }
+        allocs++;
+        BoardPtr rv(new Board(full));
+        if(count-- == stock)
+            rv->len -= firstCut;
+        return rv;
+    }
 
-        qCritical() << "no more boards";
-        return nullptr;
+    // zoberie az n celych dosiek naraz, ak by ich aquire vydal za sebou
+    int takeFull(int n)
+    {
+        if(stack || count == stock || count <= 0 || n <= 0)
+            return 0;
+        n = std::min(n, count);
+        count -= n;
+        return n;
     }
 
     void stackPush(BoardPtr&& board)
     {
-        stack.push(std::move(board));
+        allocs++;
+        stack.reset(new Offcut{*board, stack, depth() + 1});
+        deepest = std::max(deepest, depth());
     }
+
+    int allocations() const { return allocs; }
+    size_t depth() const { return stack ? stack->depth : 0; }
+    size_t maxDepth() const { return deepest; }
 };
@@ -0,0 +1,207 @@
+
+#include "headless.h"
+#include "layout.h"
+#include "layoutserver.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QImage>
+#include <QJsonDocument>
+#include <QLocalSocket>
+#include <QTextStream>
+#include <cstring>
+
+bool isHeadless(int argc, char *argv[])
+{
+    for(int i = 1; i < argc; ++i)
+    {
+        if(!std::strncmp(argv[i], "--dump", 6) || !std::strncmp(argv[i], "--check", 7) ||
+           !std::strncmp(argv[i], "--estimate", 10) || !std::strncmp(argv[i], "--stats", 7) ||
+           !std::strncmp(argv[i], "--serve", 7) || !std::strncmp(argv[i], "--submit", 8))
+            return true;
+    }
+    return false;
+}
+
+// jedna uloha pre LayoutServer, odpoved ide na stdout tak ako prisla
+static int submitJob(const QString& job, const QString& serverName, bool estimate, bool dump)
+{
+    QTextStream err(stderr);
+
+    QJsonObject json;
+    QFile file(job);
+    if(file.open(QIODevice::ReadOnly)){
+        QJsonParseError parseError;
+        auto doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+        if(!doc.isObject()){
+            err << file.fileName() << ": " << parseError.errorString() << "\n";
+            return 2;
+        }
+        json = doc.object();
+    }
+    else{
+        // pomenovany plan rozlozi az server
+        json["plan"] = job;
+        json["id"] = job;
+    }
+    if(estimate)
+        json["estimate"] = true;
+    if(dump)
+        json["dump"] = true;
+
+    QLocalSocket socket;
+    socket.connectToServer(serverName);
+    if(!socket.waitForConnected(3000)){
+        err << "cannot connect to " << serverName << ": " << socket.errorString() << "\n";
+        return 2;
+    }
+    socket.write(QJsonDocument(json).toJson(QJsonDocument::Compact) + '\n');
+    socket.flush();
+
+    while(!socket.canReadLine())
+    {
+        if(!socket.waitForReadyRead(-1)){
+            err << "no reply from " << serverName << ": " << socket.errorString() << "\n";
+            return 2;
+        }
+    }
+    auto line = socket.readLine();
+    QTextStream(stdout) << line;
+    return QJsonDocument::fromJson(line).object().contains("error") ? 1 : 0;
+}
+
+int runHeadless(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption dumpOption("dump", "Print the board layout.");
+    QCommandLineOption checkOption("check", "Compare the board layout with <golden>.", "golden");
+    QCommandLineOption planOption("plan", "Plan to lay out: reference or <length>x<width>[h|v].", "plan", "reference");
+    QCommandLineOption estimateOption("estimate", "Count boards and offcuts without placing them.");
+    QCommandLineOption statsOption("stats", "Print layout and paint counters.");
+    QCommandLineOption maxMsOption("max-ms", "Fail if the layout takes longer than <ms>.", "ms");
+    QCommandLineOption serveOption("serve", "Run a layout server on a local socket.");
+    QCommandLineOption submitOption("submit", "Send <job> (JSON file or plan) to the layout server.", "job");
+    QCommandLineOption serverOption("server", "Local socket name of the layout server.", "name",
+                                    LayoutServer::defaultName);
+    QCommandLineOption cacheOption("cache", "Results kept by the layout server.", "count", "100");
+    QCommandLineOption jobsOption("jobs", "Layouts computed in parallel by the server.", "count", "0");
+    parser.addOption(dumpOption);
+    parser.addOption(checkOption);
+    parser.addOption(estimateOption);
+    parser.addOption(statsOption);
+    parser.addOption(planOption);
+    parser.addOption(maxMsOption);
+    parser.addOption(serveOption);
+    parser.addOption(submitOption);
+    parser.addOption(serverOption);
+    parser.addOption(cacheOption);
+    parser.addOption(jobsOption);
+    parser.process(app);
+
+    Layout::quietBoardLog();
+
+    QTextStream err(stderr);
+
+    if(parser.isSet(serveOption)){
+        LayoutServer server(parser.value(cacheOption).toInt(), parser.value(jobsOption).toInt());
+        if(!server.listen(parser.value(serverOption))){
+            err << "cannot listen on " << parser.value(serverOption) << ": "
+                << server.errorString() << "\n";
+            return 2;
+        }
+        return app.exec();
+    }
+
+    if(parser.isSet(submitOption))
+        return submitJob(parser.value(submitOption), parser.value(serverOption),
+                         parser.isSet(estimateOption), parser.isSet(dumpOption));
+
+    Layout layout;
+    if(!Layout::fromName(parser.value(planOption), layout)){
+        err << "unknown plan " << parser.value(planOption) << "\n";
+        return 2;
+    }
+
+    int rv = 0;
+    const bool place = parser.isSet(dumpOption) || parser.isSet(checkOption) ||
+            parser.isSet(statsOption);
+    QElapsedTimer timer;
+    qint64 ms = 0;
+
+    if(place){
+        timer.start();
+        layout.build();
+        ms = timer.elapsed();
+    }
+
+    if(parser.isSet(estimateOption)){
+        timer.start();
+        auto estimate = layout.estimate();
+        auto estimateMs = timer.elapsed();
+        err << "estimate: " << estimate.toString() << " (" << estimateMs << " ms)\n";
+        if(place){
+            if(!(estimate == layout.summary())){
+                err << "estimate differs from placement: " << layout.summary().toString() << "\n";
+                rv = 1;
+            }
+        }
+        else{
+            QTextStream(stdout) << estimate.toString() << "\n";
+            ms = estimateMs;
+        }
+    }
+
+    if(parser.isSet(statsOption)){
+        // rovnake kreslenie ako v RenderArea, len do obrazka
+        QImage image(1600, 1000, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::white);
+        QPainter painter(&image);
+        painter.setRenderHint(QPainter::Antialiasing, true);
+        auto view = layout.view();
+        painter.setTransform(view);
+        Layout::PaintStats paintStats;
+        layout.draw(painter, Layout::BoardRef(),
+                    view.inverted().mapRect(QRectF(image.rect())), &paintStats);
+
+        err.flush();
+        QTextStream stats(parser.isSet(dumpOption) ? stderr : stdout);
+        stats << layout.stats().toString() << "\n"
+              << paintStats.toString() << "\n";
+    }
+
+    QString result;
+    QTextStream out(&result);
+    if(place)
+        layout.dump(out);
+    out.flush();
+
+    if(parser.isSet(dumpOption)){
+        QTextStream(stdout) << result;
+    }
+
+    if(parser.isSet(checkOption)){
+        QFile file(parser.value(checkOption));
+        if(!file.open(QIODevice::ReadOnly | QIODevice::Text)){
+            err << "cannot open " << file.fileName() << "\n";
+            return 2;
+        }
+        auto diff = Layout::compareDump(QString::fromUtf8(file.readAll()), result);
+        if(!diff.isEmpty()){
+            err << file.fileName() << ":" << diff << "\n";
+            rv = 1;
+        }
+    }
+
+    if(parser.isSet(maxMsOption) && ms > parser.value(maxMsOption).toLongLong()){
+        err << "layout took " << ms << " ms, limit " << parser.value(maxMsOption) << " ms\n";
+        rv = 1;
+    }
+
+    err << parser.value(planOption) << ": " << ms << " ms"
+        << (rv ? " FAIL" : " OK") << "\n";
+    return rv;
+}
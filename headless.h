@@ -0,0 +1,7 @@
+#pragma once
+
+// Kladenie bez okna: vypis vysledku (--dump) a porovnanie
+// s ulozenym vysledkom (--check) pre kontrolu zmien v Placer a BoardFactory.
+// --serve spusti LayoutServer, --submit mu posle jednu ulohu.
+bool isHeadless(int argc, char *argv[]);
+int runHeadless(int argc, char *argv[]);
@@ -0,0 +1,860 @@
+
+#include "layout.h"
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLoggingCategory>
+#include <QRegularExpression>
+#include <QTextStream>
+#include <QTransform>
+#include <algorithm>
+
+struct Steny
+{
+    QRectF dvere;
+    QRectF nosnaVonkajsia;
+    QRectF nosnaVnutorna;
+    QRectF prieckaStred;
+    QRectF prieckaSused;
+};
+
+Layout Layout::reference()
+{
+    constexpr double dilat = 10;
+    constexpr double roomV = 5140-2*dilat;
+    constexpr double room1H = 4330-2*dilat;
+    constexpr double room2H = /*4650*/4590-2*dilat;
+    constexpr double wallWidth = 180+2*dilat;
+    constexpr double roomsH = room1H + wallWidth + room2H;
+    constexpr double doorOfset = 50+dilat;
+    constexpr double doorWith = 900-2*dilat;
+
+    Layout rv;
+
+    QPainterPath& path = rv.outline;
+    path.moveTo(-wallWidth, -wallWidth);
+    path.lineTo(roomsH+wallWidth, -wallWidth);
+    path.lineTo(roomsH+wallWidth, roomV+wallWidth);
+    path.lineTo(-wallWidth, roomV+wallWidth);
+    path.closeSubpath();
+    path.moveTo(0,0);
+    path.lineTo(room1H,0);
+    path.lineTo(room1H,doorOfset);
+    path.lineTo(room1H+wallWidth, doorOfset);
+    path.lineTo(room1H+wallWidth,0);
+    path.lineTo(roomsH,0);
+    path.lineTo(roomsH,roomV);
+    path.lineTo(roomsH-room2H,roomV);
+    path.lineTo(roomsH-room2H, doorWith+doorOfset);
+    path.lineTo(room1H, doorWith+doorOfset);
+    path.lineTo(room1H,roomV);
+    path.lineTo(0,roomV);
+    path.closeSubpath();
+
+    const Steny stena {
+        QRectF(QPoint(room1H,doorOfset), QSizeF(wallWidth,doorWith)),
+        QRectF(QPoint(0,roomV), QSizeF(100e3,100e3)),
+        QRectF(QPoint(0,-wallWidth), QSizeF(100e3,wallWidth)),
+        QRectF (QPoint(room1H,0), QSizeF(wallWidth,100e3)),
+        QRectF (QPoint(roomsH,0), QSizeF(wallWidth,100e3)),
+    };
+    rv.doors.push_back(stena.dvere);
+
+    Room spodna;
+    spodna.name = "SPODNA";
+    spodna.dir = PlacedBoard::Dir::vertical;
+    spodna.start = QPoint(0,roomV);
+    spodna.block = stena.nosnaVnutorna;
+    spodna.blockSide = stena.prieckaSused;
+    spodna.firtsLineCut = 240;
+    spodna.color = Qt::red;
+    // Spakyho zlom
+    spodna.overrides[std::make_pair(6,3)].offcutExtra = 80;
+    rv.addRoom(spodna);
+
+    Room vrchna;
+    vrchna.name = "VRCHNA";
+    vrchna.dir = PlacedBoard::Dir::horizontal;
+    vrchna.start = QPoint(0,0);
+    vrchna.block = stena.prieckaSused;
+    vrchna.blockSide = stena.nosnaVonkajsia;
+    vrchna.dvere = stena.dvere;
+    vrchna.blockDvere = stena.prieckaStred;
+    vrchna.hasDvere = true;
+    vrchna.color = Qt::blue;
+    rv.addRoom(vrchna);
+
+    vrchna.name = "VRCHNA2";
+    vrchna.start = QPoint(room1H+wallWidth,625*2);
+    rv.addRoom(vrchna);
+
+    return rv;
+}
+
+// jedna obdlznikova miestnost, steny hrube 200, sklad podla plochy a dosky
+Layout Layout::rectangle(double length, double width, PlacedBoard::Dir dir,
+                         const Board& board)
+{
+    constexpr double wallWidth = 200;
+    const double far = length + width + 100e3;
+
+    Layout rv;
+    rv.outline.addRect(-wallWidth, -wallWidth, length+2*wallWidth, width+2*wallWidth);
+    rv.outline.addRect(0, 0, length, width);
+    rv.stockBoard = board;
+    rv.stock = int(length*width / (board.len*board.width) * 2) + 10;
+
+    Room room;
+    room.name = QString("%1x%2").arg(length).arg(width);
+    room.dir = dir;
+    room.color = Qt::blue;
+    if(dir == PlacedBoard::Dir::horizontal){
+        room.start = QPointF(0,0);
+        room.block = QRectF(QPointF(length,0), QSizeF(wallWidth,far));
+        room.blockSide = QRectF(QPointF(0,width), QSizeF(far,far));
+    }
+    else{
+        room.start = QPointF(0,width);
+        room.block = QRectF(QPointF(0,-wallWidth), QSizeF(far,wallWidth));
+        room.blockSide = QRectF(QPointF(length,0), QSizeF(wallWidth,far));
+    }
+    rv.addRoom(room);
+    return rv;
+}
+
+// "reference" alebo "<dlzka>x<sirka>[h|v]", napr. 8000x6000v
+bool Layout::fromName(const QString& plan, Layout& layout, const Board& board)
+{
+    if(plan == "reference"){
+        layout = Layout::reference();
+        layout.stockBoard = board;
+        return true;
+    }
+
+    QRegularExpression re("^(\\d+)x(\\d+)([hv]?)$");
+    auto m = re.match(plan);
+    if(!m.hasMatch())
+        return false;
+
+    auto dir = m.captured(3) == "v" ? PlacedBoard::Dir::vertical
+                                    : PlacedBoard::Dir::horizontal;
+    layout = Layout::rectangle(m.captured(1).toDouble(), m.captured(2).toDouble(), dir, board);
+    return true;
+}
+
+static QJsonArray toJson(QPointF p)
+{
+    return QJsonArray{p.x(), p.y()};
+}
+
+static QJsonArray toJson(const QRectF& r)
+{
+    return QJsonArray{r.x(), r.y(), r.width(), r.height()};
+}
+
+static bool fromJson(const QJsonValue& v, QPointF& p)
+{
+    auto a = v.toArray();
+    if(a.size() != 2)
+        return false;
+    p = QPointF(a[0].toDouble(), a[1].toDouble());
+    return true;
+}
+
+static bool fromJson(const QJsonValue& v, QRectF& r)
+{
+    auto a = v.toArray();
+    if(a.size() != 4)
+        return false;
+    r = QRectF(a[0].toDouble(), a[1].toDouble(), a[2].toDouble(), a[3].toDouble());
+    return true;
+}
+
+// Vsetko, od coho zavisi vysledok kladenia. Obrys a farby sa len kreslia,
+// preto tu nie su a nemenia ani hash(). Nazov miestnosti je len vo vypise
+// dump(), bez names chyba a rovnake miestnosti s inym nazvom maju rovnaky hash().
+QJsonObject Layout::toJson(bool names) const
+{
+    QJsonArray jrooms;
+    for(auto& rs : rooms)
+    {
+        auto& room = rs.room;
+        QJsonObject jr;
+        if(names)
+            jr["name"] = room.name;
+        jr["dir"] = room.dir == PlacedBoard::Dir::vertical ? "v" : "h";
+        jr["start"] = ::toJson(room.start);
+        jr["block"] = ::toJson(room.block);
+        jr["blockSide"] = ::toJson(room.blockSide);
+        if(room.hasDvere){
+            jr["dvere"] = ::toJson(room.dvere);
+            jr["blockDvere"] = ::toJson(room.blockDvere);
+        }
+        jr["firstLineCut"] = room.firtsLineCut;
+
+        QJsonArray jo;
+        for(auto& o : room.overrides)
+        {
+            QJsonObject j;
+            j["row"] = o.first.first;
+            j["board"] = o.first.second;
+            j["locked"] = o.second.locked;
+            j["pos"] = ::toJson(o.second.pos);
+            j["len"] = o.second.len;
+            j["shift"] = o.second.shift;
+            j["offcutExtra"] = o.second.offcutExtra;
+            jo.append(j);
+        }
+        jr["overrides"] = jo;
+        jrooms.append(jr);
+    }
+
+    QJsonObject rv;
+    rv["stock"] = stock;
+    rv["board"] = QJsonObject{{"len", stockBoard.len}, {"width", stockBoard.width}};
+    rv["rooms"] = jrooms;
+    return rv;
+}
+
+// Plan je bud pomenovany ("plan": "reference"), alebo zoznam miestnosti
+// ("rooms"). "board" plati aj pre pomenovany plan a obdlznik podla neho
+// urci sklad, "stock" ho prepise.
+bool Layout::fromJson(const QJsonObject& json, Layout& layout, QString* error)
+{
+    auto fail = [error](const QString& msg){
+        if(error)
+            *error = msg;
+        return false;
+    };
+
+    Board board;
+    if(json.contains("board")){
+        const auto jb = json["board"].toObject();
+        board.len = jb["len"].toDouble(board.len);
+        board.width = jb["width"].toDouble(board.width);
+        // z prvej dosky sa odreze BoardFactory::firstCut
+        if(board.len <= BoardFactory::firstCut || board.width <= 0)
+            return fail(QString("board len must be over %1 and width positive")
+                        .arg(BoardFactory::firstCut));
+    }
+
+    if(json.contains("plan")){
+        if(!fromName(json["plan"].toString(), layout, board))
+            return fail("unknown plan " + json["plan"].toString());
+    }
+    else{
+        layout = Layout();
+        layout.stockBoard = board;
+        for(auto v : json["rooms"].toArray())
+        {
+            const auto jr = v.toObject();
+            Room room;
+            room.name = jr["name"].toString();
+            room.dir = jr["dir"].toString() == "v" ? PlacedBoard::Dir::vertical
+                                                   : PlacedBoard::Dir::horizontal;
+            room.color = Qt::blue;
+            if(!::fromJson(jr["start"], room.start) ||
+               !::fromJson(jr["block"], room.block) ||
+               !::fromJson(jr["blockSide"], room.blockSide))
+                return fail("room " + room.name + ": start, block and blockSide are required");
+            if(jr.contains("dvere") || jr.contains("blockDvere")){
+                if(!::fromJson(jr["dvere"], room.dvere) ||
+                   !::fromJson(jr["blockDvere"], room.blockDvere))
+                    return fail("room " + room.name + ": dvere needs blockDvere");
+                room.hasDvere = true;
+            }
+            room.firtsLineCut = jr["firstLineCut"].toDouble();
+
+            for(auto ov : jr["overrides"].toArray())
+            {
+                const auto jo = ov.toObject();
+                BoardOverride o;
+                o.locked = jo["locked"].toBool();
+                ::fromJson(jo["pos"], o.pos);
+                o.len = jo["len"].toDouble();
+                o.shift = jo["shift"].toDouble();
+                o.offcutExtra = jo["offcutExtra"].toDouble();
+                room.overrides[std::make_pair(jo["row"].toInt(), jo["board"].toInt())] = o;
+            }
+            layout.addRoom(room);
+        }
+        if(layout.rooms.empty())
+            return fail("plan has no rooms");
+    }
+
+    // aj pomenovany plan ma pevny firtsLineCut, uzsia doska by mala zapornu sirku
+    for(auto& rs : layout.rooms)
+    {
+        if(rs.room.firtsLineCut < 0 || rs.room.firtsLineCut >= board.width)
+            return fail("room " + rs.room.name + ": firstLineCut must be below board width");
+    }
+
+    if(json.contains("stock")){
+        layout.stock = json["stock"].toInt();
+        if(layout.stock <= 0)
+            return fail("stock must be a positive number of boards");
+    }
+    return true;
+}
+
+QByteArray Layout::hash(bool names) const
+{
+    auto json = QJsonDocument(toJson(names)).toJson(QJsonDocument::Compact);
+    return QCryptographicHash::hash(json, QCryptographicHash::Sha1).toHex();
+}
+
+void Layout::addRoom(const Room& room)
+{
+    RoomState rs;
+    rs.room = room;
+    rooms.push_back(std::move(rs));
+}
+
+void Layout::build()
+{
+    begin();
+    while(step());
+}
+
+void Layout::begin()
+{
+    factory = BoardFactory(stock, stockBoard);
+    stockEnd = factory.snapshot();
+    undoStack.clear();
+    redoStack.clear();
+    for(auto& rs : rooms)
+        rs.rows.clear();
+    buildRoom = 0;
+    layoutStats = Stats();
+}
+
+// polozi dalsi riadok, false ak uz su vsetky miestnosti hotove
+bool Layout::step()
+{
+    if(isComplete())
+        return false;
+
+    auto& rs = rooms[buildRoom];
+    if(rs.rows.empty())
+        qDebug() << rs.room.name;
+
+    Placer placer(rs.room.dir, factory);
+    QPointF start = rs.rows.empty() ? rs.room.start : rs.rows.back()->row.next;
+    auto row = placeRow(placer, rs.room, start, rs.rows.size());
+    bool last = row->row.last;
+    rs.rows.push_back(std::move(row));
+    stockEnd = factory.snapshot();
+    if(last)
+        ++buildRoom;
+    return !isComplete();
+}
+
+Layout::RowPtr Layout::placeRow(Placer& placer, const Room& room, QPointF start, int riadok)
+{
+    QElapsedTimer timer;
+    timer.start();
+    int allocs = placer.allocations() + factory.allocations();
+
+    std::shared_ptr<RowState> rv(new RowState);
+    rv->start = start;
+    rv->factory = factory.snapshot();
+    rv->row = placer.placeRow(start, riadok+1, limits(room), room.overrides);
+
+    layoutStats.layoutNs += timer.nsecsElapsed();
+    layoutStats.rows++;
+    layoutStats.allocations += placer.allocations() + factory.allocations() - allocs;
+    layoutStats.stackDepth = factory.depth();
+    layoutStats.maxStackDepth = std::max(layoutStats.maxStackDepth, int(factory.maxDepth()));
+    return rv;
+}
+
+PlaceLimits Layout::limits(const Room& room)
+{
+    PlaceLimits rv;
+    rv.block = &room.block;
+    rv.blockSide = &room.blockSide;
+    if(room.hasDvere){
+        rv.dvere = &room.dvere;
+        rv.blockDvere = &room.blockDvere;
+    }
+    rv.firtsLineCut = room.firtsLineCut;
+    return rv;
+}
+
+// Pocet riadkov sa meni len vtedy, ked flow preklada az po posledny riadok
+// miestnosti, vtedy sa nahradza koniec vektora. Ostatne riadky sa neposuvaju,
+// takze undo a redo stoja len vymenene riadky.
+void Layout::replaceRows(std::vector<RowPtr>& rows, int pos, size_t count,
+                         const std::vector<RowPtr>& with)
+{
+    if(count == with.size()){
+        std::copy(with.begin(), with.end(), rows.begin()+pos);
+        return;
+    }
+    Q_ASSERT(pos + count == rows.size());
+    rows.resize(pos);
+    rows.insert(rows.end(), with.begin(), with.end());
+}
+
+// Preklada riadky od fromRow. Riadky za dirtyRow, ktore zacinaju na rovnakom
+// mieste s rovnakym skladom ako predtym, sa uz nezmenia a ostavaju z cache.
+bool Layout::flow(int room, int fromRow, int dirtyRow, Change* change)
+{
+    auto& rs = rooms[room];
+    Placer placer(rs.room.dir, factory);
+    QPointF start = fromRow > 0 ? rs.rows[fromRow-1]->row.next : rs.room.start;
+
+    std::vector<RowPtr> placed;
+    int riadok = fromRow;
+    bool converged = false;
+    for(;; ++riadok)
+    {
+        if(riadok > dirtyRow && riadok < int(rs.rows.size()) &&
+           rs.rows[riadok]->start == start && rs.rows[riadok]->factory == factory.snapshot())
+        {
+            converged = true;
+            break;
+        }
+
+        auto s = placeRow(placer, rs.room, start, riadok);
+        start = s->row.next;
+        bool last = s->row.last;
+        placed.push_back(std::move(s));
+        if(last){
+            riadok = rs.rows.size();
+            break;
+        }
+    }
+
+    if(change){
+        Splice sp;
+        sp.room = room;
+        sp.pos = fromRow;
+        sp.removed.assign(rs.rows.begin()+fromRow, rs.rows.begin()+riadok);
+        sp.inserted = placed;
+        change->splices.push_back(std::move(sp));
+    }
+    replaceRows(rs.rows, fromRow, riadok-fromRow, placed);
+    return converged;
+}
+
+void Layout::reflow(int room, int fromRow, Change* change)
+{
+    layoutStats = Stats();
+    factory.restore(rooms[room].rows[fromRow]->factory);
+    int dirtyRow = fromRow;
+    for(; room < int(rooms.size()); ++room)
+    {
+        if(flow(room, fromRow, dirtyRow, change))
+            return;
+        fromRow = 0;
+        dirtyRow = -1;
+    }
+    // preskladane az po koniec, inak sa koncovy sklad nezmenil
+    stockEnd = factory.snapshot();
+}
+
+void Layout::setOverride(int room, std::pair<int,int> key, const BoardOverride& ovr)
+{
+    auto& overrides = rooms[room].room.overrides;
+    if(ovr.isNull())
+        overrides.erase(key);
+    else
+        overrides[key] = ovr;
+}
+
+bool Layout::undo()
+{
+    if(undoStack.empty() || !isComplete())
+        return false;
+    auto& ch = undoStack.back();
+    setOverride(ch.room, ch.key, ch.before);
+    for(auto it = ch.splices.rbegin(); it != ch.splices.rend(); ++it)
+        replaceRows(rooms[it->room].rows, it->pos, it->inserted.size(), it->removed);
+    stockEnd = ch.stockBefore;
+    redoStack.push_back(std::move(ch));
+    undoStack.pop_back();
+    return true;
+}
+
+bool Layout::redo()
+{
+    if(redoStack.empty() || !isComplete())
+        return false;
+    auto& ch = redoStack.back();
+    setOverride(ch.room, ch.key, ch.after);
+    for(auto& sp : ch.splices)
+        replaceRows(rooms[sp.room].rows, sp.pos, sp.removed.size(), sp.inserted);
+    stockEnd = ch.stockAfter;
+    undoStack.push_back(std::move(ch));
+    redoStack.pop_back();
+    return true;
+}
+
+Layout::Summary Layout::summary() const
+{
+    Summary rv;
+    bool placed = false;
+    for(auto& rs : rooms)
+    {
+        for(auto& r : rs.rows)
+        {
+            rv.pieces += r->row.boards.size();
+            rv.exhausted = rv.exhausted || r->row.exhausted;
+            rv.capped = rv.capped || r->row.capped;
+            placed = true;
+        }
+    }
+    if(placed)
+        stockSummary(rv, stockEnd);
+    return rv;
+}
+
+void Layout::stockSummary(Summary& s, const BoardFactory::Snapshot& end) const
+{
+    s.boards = stock - end.count;
+    s.offcuts = end.depth();
+    s.offcutLen = 0;
+    for(auto o = end.stack.get(); o; o = o->next.get())
+        s.offcutLen += o->board.len;
+}
+
+static bool hasRowOverride(const BoardOverrides& overrides, int riadok)
+{
+    auto it = overrides.lower_bound(std::make_pair(riadok, 0));
+    return it != overrides.end() && it->first.first == riadok;
+}
+
+// Rovnaky vysledok ako summary() po build(), ale bez kladenia jednotlivych
+// dosiek: kazdy riadok stoji len par dosiek pri stene.
+Layout::Summary Layout::estimate() const
+{
+    Summary rv;
+    BoardFactory sklad(stock, stockBoard);
+    for(auto& rs : rooms)
+    {
+        Placer placer(rs.room.dir, sklad);
+        const auto lim = limits(rs.room);
+        QPointF start = rs.room.start;
+        for(int riadok = 1;; ++riadok)
+        {
+            bool last;
+            if(hasRowOverride(rs.room.overrides, riadok)){
+                auto row = placer.placeRow(start, riadok, lim, rs.room.overrides);
+                rv.pieces += row.boards.size();
+                rv.exhausted = rv.exhausted || row.exhausted;
+                rv.capped = rv.capped || row.capped;
+                start = row.next;
+                last = row.last;
+            }
+            else{
+                auto row = placer.countRow(start, riadok, lim);
+                rv.pieces += row.pieces;
+                rv.exhausted = rv.exhausted || row.exhausted;
+                rv.capped = rv.capped || row.capped;
+                start = row.next;
+                last = row.last;
+            }
+            if(last)
+                break;
+        }
+    }
+    if(!rooms.empty())
+        stockSummary(rv, sklad.snapshot());
+    return rv;
+}
+
+QJsonObject Layout::Summary::toJson() const
+{
+    QJsonObject rv;
+    rv["boards"] = boards;
+    rv["pieces"] = pieces;
+    rv["offcuts"] = offcuts;
+    rv["offcutLen"] = offcutLen;
+    rv["exhausted"] = exhausted;
+    rv["capped"] = capped;
+    return rv;
+}
+
+QString Layout::Summary::toString() const
+{
+    return QString("boards %1 pieces %2 offcuts %3 offcutLen %4 exhausted %5 capped %6")
+            .arg(boards).arg(pieces).arg(offcuts)
+            .arg(QString::number(offcutLen, 'f', 1))
+            .arg(exhausted ? 1 : 0).arg(capped ? 1 : 0);
+}
+
+static QString cutFlags(const Board& b)
+{
+    QString rv("----");
+    if(b.cutH) rv[0] = 'H';
+    if(b.cutT) rv[1] = 'T';
+    if(b.cutL) rv[2] = 'L';
+    if(b.cutR) rv[3] = 'R';
+    return rv;
+}
+
+// textovy vypis pre porovnanie s ulozenym vysledkom (--dump, --check)
+void Layout::dump(QTextStream& out) const
+{
+    for(auto& rs : rooms)
+    {
+        out << "room " << rs.room.name << "\n";
+        for(size_t i = 0; i < rs.rows.size(); ++i)
+        {
+            auto& boards = rs.rows[i]->row.boards;
+            for(size_t j = 0; j < boards.size(); ++j)
+            {
+                auto& b = *boards[j];
+                out << i+1 << " " << j+1
+                    << " " << QString::number(b.x(), 'f', 1)
+                    << " " << QString::number(b.y(), 'f', 1)
+                    << " " << QString::number(b.width(), 'f', 1)
+                    << " " << QString::number(b.height(), 'f', 1)
+                    << " " << cutFlags(b.material()) << "\n";
+            }
+        }
+    }
+
+    out << summary().toString() << "\n";
+}
+
+// prvy riadok, v ktorom sa vypis dump() lisi od ulozeneho, inak prazdny retazec
+QString Layout::compareDump(const QString& golden, const QString& actual)
+{
+    auto g = golden.split('\n');
+    auto a = actual.split('\n');
+    for(int i = 0; i < std::max(g.size(), a.size()); ++i)
+    {
+        auto gl = i < g.size() ? g[i] : QString();
+        auto al = i < a.size() ? a[i] : QString();
+        if(gl != al)
+            return QString("%1: expected \"%2\", got \"%3\"").arg(i+1).arg(gl).arg(al);
+    }
+    return QString();
+}
+
+// vypis kazdej dosky z Placer by zahltil vystup aj meranie casu
+void Layout::quietBoardLog()
+{
+    QLoggingCategory::setFilterRules("*.debug=false\n*.info=false");
+}
+
+Layout::BoardRef Layout::boardAt(QPointF p) const
+{
+    for(size_t r = 0; r < rooms.size(); ++r)
+    {
+        auto& rows = rooms[r].rows;
+        for(size_t i = 0; i < rows.size(); ++i)
+        {
+            auto& boards = rows[i]->row.boards;
+            for(size_t j = 0; j < boards.size(); ++j)
+            {
+                if(boards[j]->contains(p))
+                    return BoardRef(r, i, j);
+            }
+        }
+    }
+    return BoardRef();
+}
+
+const PlacedBoard* Layout::board(BoardRef ref) const
+{
+    if(!ref.isValid() || ref.room >= int(rooms.size()))
+        return nullptr;
+    auto& rows = rooms[ref.room].rows;
+    if(ref.row >= int(rows.size()))
+        return nullptr;
+    auto& boards = rows[ref.row]->row.boards;
+    if(ref.index >= int(boards.size()))
+        return nullptr;
+    return boards[ref.index].get();
+}
+
+// posledna doska v riadku je zarezana do steny, jej dlzku urcuje stena
+bool Layout::lastInRow(BoardRef ref) const
+{
+    return board(ref) &&
+            ref.index+1 == int(rooms[ref.room].rows[ref.row]->row.boards.size());
+}
+
+BoardOverride Layout::boardOverride(BoardRef ref) const
+{
+    if(!board(ref))
+        return BoardOverride();
+    auto& overrides = rooms[ref.room].room.overrides;
+    auto it = overrides.find(std::make_pair(ref.row+1, ref.index+1));
+    return it != overrides.end() ? it->second : BoardOverride();
+}
+
+void Layout::setBoardOverride(BoardRef ref, const BoardOverride& ovr)
+{
+    // pocas postupneho kladenia sa neupravuje
+    if(!board(ref) || !isComplete())
+        return;
+    // uprava bez zmeny by len zmazala historiu pre redo
+    if(ovr == boardOverride(ref))
+        return;
+    Change ch;
+    ch.room = ref.room;
+    ch.key = std::make_pair(ref.row+1, ref.index+1);
+    ch.before = boardOverride(ref);
+    ch.after = ovr;
+    ch.stockBefore = stockEnd;
+    setOverride(ch.room, ch.key, ovr);
+    reflow(ref.room, ref.row, &ch);
+    ch.stockAfter = stockEnd;
+    undoStack.push_back(std::move(ch));
+    redoStack.clear();
+}
+
+void Layout::lockBoard(BoardRef ref, bool lock)
+{
+    auto b = board(ref);
+    if(!b)
+        return;
+    auto ovr = boardOverride(ref);
+    ovr.locked = lock;
+    ovr.pos = lock ? b->origin() : QPointF();
+    ovr.len = 0;
+    if(lock && !lastInRow(ref))
+        ovr.len = b->material().len;
+    setBoardOverride(ref, ovr);
+}
+
+void Layout::moveBoard(BoardRef ref, double delta)
+{
+    if(!board(ref))
+        return;
+    auto ovr = boardOverride(ref);
+    if(ovr.locked){
+        if(rooms[ref.room].room.dir == PlacedBoard::Dir::horizontal)
+            ovr.pos.rx() += delta;
+        else
+            ovr.pos.ry() -= delta;
+    }
+    else{
+        ovr.shift += delta;
+    }
+    setBoardOverride(ref, ovr);
+}
+
+void Layout::resizeBoard(BoardRef ref, double delta)
+{
+    auto b = board(ref);
+    // skratena posledna doska by nedosiahla stenu a riadok by pridal kusok
+    if(!b || lastInRow(ref))
+        return;
+    auto ovr = boardOverride(ref);
+    double len = (ovr.len > 0 ? ovr.len : b->material().len) + delta;
+    // dlhsia doska nie je v sklade, plna dlzka znamena bez skratenia
+    if(len <= 0 || len > b->takenLen())
+        return;
+    ovr.len = len < b->takenLen() ? len : 0;
+    setBoardOverride(ref, ovr);
+}
+
+QTransform Layout::view() const
+{
+    auto bounds = outline.boundingRect();
+    QTransform t;
+    t.scale(0.1,-0.1);
+    t.translate(-bounds.left(), -bounds.bottom());
+    return t;
+}
+
+// clip je v suradniciach podlahy, dosky mimo neho sa nekreslia
+void Layout::draw(QPainter& painter, BoardRef selected,
+                  const QRectF& clip, PaintStats* stats) const
+{
+    PaintStats ps;
+    QElapsedTimer timer;
+    timer.start();
+
+    painter.setPen(QPen(Qt::green, 0, Qt::SolidLine,
+                        Qt::FlatCap, Qt::MiterJoin));
+    painter.setBrush(QBrush{Qt::green, Qt::BrushStyle::FDiagPattern});
+    painter.drawPath(outline);
+
+    painter.setPen(QPen(Qt::cyan, 0, Qt::SolidLine,
+                        Qt::FlatCap, Qt::MiterJoin));
+    painter.setBrush(QBrush{Qt::cyan, Qt::BrushStyle::FDiagPattern});
+    for(auto& d : doors)
+        painter.drawRect(d);
+    ps.outlineNs = timer.nsecsElapsed();
+
+    auto visible = [&clip](const PlacedBoard& b){
+        return clip.isNull() || clip.intersects(b);
+    };
+
+    for(auto& rs : rooms)
+    {
+        painter.setPen(QPen(rs.room.color, 0, Qt::SolidLine,
+                            Qt::FlatCap, Qt::MiterJoin));
+        painter.setBrush(QBrush{Qt::cyan, Qt::BrushStyle::NoBrush});
+        for(auto& r : rs.rows)
+        {
+            for(auto& b : r->row.boards)
+            {
+                if(visible(*b)){
+                    b->draw(painter);
+                    ++ps.drawn;
+                }
+                else{
+                    ++ps.culled;
+                }
+            }
+        }
+
+        painter.setBrush(QBrush{rs.room.color, Qt::BrushStyle::BDiagPattern});
+        for(auto& o : rs.room.overrides)
+        {
+            auto b = board(BoardRef(&rs - &rooms.front(),
+                                    o.first.first-1, o.first.second-1));
+            if(o.second.locked && b)
+                painter.drawRect(*b);
+        }
+    }
+    ps.boardsNs = timer.nsecsElapsed() - ps.outlineNs;
+
+    for(auto& rs : rooms)
+    {
+        painter.setPen(QPen(rs.room.color, 0, Qt::SolidLine,
+                            Qt::FlatCap, Qt::MiterJoin));
+        for(auto& r : rs.rows)
+            for(auto& b : r->row.boards)
+                if(visible(*b))
+                    b->drawDecor(painter);
+    }
+    ps.decorNs = timer.nsecsElapsed() - ps.outlineNs - ps.boardsNs;
+
+    if(auto b = board(selected)){
+        painter.setPen(QPen(Qt::black, 0, Qt::SolidLine,
+                            Qt::FlatCap, Qt::MiterJoin));
+        painter.setBrush(QBrush{Qt::yellow, Qt::BrushStyle::Dense4Pattern});
+        painter.drawRect(*b);
+    }
+
+    if(stats)
+        *stats = ps;
+}
+
+static QString ms(qint64 ns)
+{
+    return QString::number(ns / 1e6, 'f', 2);
+}
+
+QString Layout::Stats::toString() const
+{
+    return QString("layout %1 ms rows %2 alloc %3 offcuts %4 (max %5)")
+            .arg(ms(layoutNs)).arg(rows).arg(allocations)
+            .arg(stackDepth).arg(maxStackDepth);
+}
+
+QString Layout::PaintStats::toString() const
+{
+    return QString("outline %1 ms boards %2 ms decor %3 ms drawn %4 culled %5")
+            .arg(ms(outlineNs)).arg(ms(boardsNs)).arg(ms(decorNs))
+            .arg(drawn).arg(culled);
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <QByteArray>
+#include <QColor>
+#include <QJsonObject>
+#include <QPainterPath>
+#include <QString>
+#include "placer.h"
+
+class QTextStream;
+class QTransform;
+
+// Vysledok kladenia vsetkych miestnosti. Kazdy riadok si pamata stav skladu
+// pred sebou, takze po uprave jednej dosky sa preklada len jej riadok a tie
+// nasledujuce, ktore zavisia od zmenenych odrezkov v BoardFactory.
+// Riadky su nemenne a zdielane, historia uprav si drzi len vymenene riadky.
+class Layout
+{
+public:
+    struct Room
+    {
+        QString name;
+        PlacedBoard::Dir dir = PlacedBoard::Dir::horizontal;
+        QPointF start;
+        QRectF block;
+        QRectF blockSide;
+        QRectF dvere;
+        QRectF blockDvere;
+        bool hasDvere = false;
+        double firtsLineCut = 0;
+        QColor color;
+        BoardOverrides overrides;
+    };
+
+    struct BoardRef
+    {
+        BoardRef(int room = -1, int row = -1, int index = -1)
+            :room(room), row(row), index(index)
+        {}
+
+        int room;
+        int row;
+        int index;
+
+        bool isValid() const { return room >= 0; }
+    };
+
+    struct Summary
+    {
+        int boards = 0;         // celych dosiek zo skladu
+        int pieces = 0;         // polozenych kusov
+        int offcuts = 0;        // nepouzitych odrezkov
+        double offcutLen = 0;
+        bool exhausted = false;
+        bool capped = false;    // riadok alebo miestnost nedosiahla stenu
+
+        bool operator==(const Summary& o) const
+        {
+            return boards == o.boards && pieces == o.pieces &&
+                    offcuts == o.offcuts && offcutLen == o.offcutLen &&
+                    exhausted == o.exhausted && capped == o.capped;
+        }
+        QString toString() const;
+        QJsonObject toJson() const;
+    };
+
+    // pocitadla posledneho kladenia (build alebo preskladanie po uprave)
+    struct Stats
+    {
+        qint64 layoutNs = 0;
+        int rows = 0;
+        int allocations = 0;    // new Board a new PlacedBoard
+        int stackDepth = 0;     // odrezky v BoardFactory po poslednom riadku
+        int maxStackDepth = 0;
+
+        QString toString() const;
+    };
+
+    struct PaintStats
+    {
+        qint64 outlineNs = 0;
+        qint64 boardsNs = 0;
+        qint64 decorNs = 0;
+        int drawn = 0;
+        int culled = 0;
+
+        QString toString() const;
+    };
+
+    static Layout reference();
+    static Layout rectangle(double length, double width, PlacedBoard::Dir dir,
+                            const Board& board = Board());
+    static bool fromName(const QString& plan, Layout& layout, const Board& board = Board());
+    static bool fromJson(const QJsonObject& json, Layout& layout, QString* error = nullptr);
+
+    QJsonObject toJson(bool names = true) const;
+    QByteArray hash(bool names = false) const;
+
+    void addRoom(const Room& room);
+    void build();
+
+    void begin();
+    bool step();
+    bool isComplete() const { return buildRoom >= int(rooms.size()); }
+
+    Summary summary() const;
+    Summary estimate() const;
+    const Stats& stats() const { return layoutStats; }
+    void dump(QTextStream& out) const;
+    static QString compareDump(const QString& golden, const QString& actual);
+    static void quietBoardLog();
+
+    BoardRef boardAt(QPointF p) const;
+    const PlacedBoard* board(BoardRef ref) const;
+
+    BoardOverride boardOverride(BoardRef ref) const;
+    void setBoardOverride(BoardRef ref, const BoardOverride& ovr);
+    void lockBoard(BoardRef ref, bool lock);
+    void moveBoard(BoardRef ref, double delta);
+    void resizeBoard(BoardRef ref, double delta);
+
+    bool canUndo() const { return !undoStack.empty(); }
+    bool canRedo() const { return !redoStack.empty(); }
+    bool undo();
+    bool redo();
+
+    QTransform view() const;
+    void draw(QPainter& painter,
+              BoardRef selected = BoardRef(),
+              const QRectF& clip = QRectF(),
+              PaintStats* stats = nullptr) const;
+
+    QPainterPath outline;
+    std::vector<QRectF> doors;
+    int stock = 74;
+    Board stockBoard;
+
+private:
+    struct RowState
+    {
+        QPointF start;
+        BoardFactory::Snapshot factory;
+        Placer::Row row;
+    };
+
+    using RowPtr = std::shared_ptr<const RowState>;
+
+    struct RoomState
+    {
+        Room room;
+        std::vector<RowPtr> rows;
+    };
+
+    // riadky [pos, pos+removed.size()) nahradene riadkami inserted
+    struct Splice
+    {
+        int room;
+        int pos;
+        std::vector<RowPtr> removed;
+        std::vector<RowPtr> inserted;
+    };
+
+    struct Change
+    {
+        int room;
+        std::pair<int,int> key;
+        BoardOverride before;
+        BoardOverride after;
+        BoardFactory::Snapshot stockBefore;
+        BoardFactory::Snapshot stockAfter;
+        std::vector<Splice> splices;
+    };
+
+    static PlaceLimits limits(const Room& room);
+    bool lastInRow(BoardRef ref) const;
+    void stockSummary(Summary& s, const BoardFactory::Snapshot& end) const;
+    static void replaceRows(std::vector<RowPtr>& rows, int pos, size_t count,
+                            const std::vector<RowPtr>& with);
+    RowPtr placeRow(Placer& placer, const Room& room, QPointF start, int riadok);
+    void setOverride(int room, std::pair<int,int> key, const BoardOverride& ovr);
+    bool flow(int room, int fromRow, int dirtyRow, Change* change);
+    void reflow(int room, int fromRow, Change* change);
+
+    BoardFactory factory;
+    BoardFactory::Snapshot stockEnd;    // sklad po poslednom riadku
+    std::vector<RoomState> rooms;
+    int buildRoom = 0;
+    Stats layoutStats;
+    std::vector<Change> undoStack;
+    std::vector<Change> redoStack;
+};
@@ -0,0 +1,155 @@
+
+#include "layoutserver.h"
+#include "layout.h"
+#include <QFutureWatcher>
+#include <QJsonDocument>
+#include <QLocalSocket>
+#include <QTextStream>
+#include <QtConcurrent>
+
+constexpr const char* LayoutServer::defaultName;
+
+LayoutServer::LayoutServer(int cacheSize, int jobs, QObject *parent)
+    : QObject(parent)
+    , cache(cacheSize)
+{
+    if(jobs > 0)
+        pool.setMaxThreadCount(jobs);
+    connect(&server, &QLocalServer::newConnection, this, &LayoutServer::newConnection);
+}
+
+bool LayoutServer::listen(const QString& name)
+{
+    // bezuci server si meno necha, druhy --serve skonci s chybou
+    QLocalSocket probe;
+    probe.connectToServer(name);
+    if(probe.waitForConnected(1000)){
+        probe.disconnectFromServer();
+        listenError = "another layout server is running";
+        return false;
+    }
+
+    // socket po spadnutom serveri by inak blokoval listen
+    QLocalServer::removeServer(name);
+    if(!server.listen(name)){
+        listenError = server.errorString();
+        return false;
+    }
+    listenError.clear();
+    return true;
+}
+
+QString LayoutServer::errorString() const
+{
+    return listenError;
+}
+
+void LayoutServer::newConnection()
+{
+    while(auto socket = server.nextPendingConnection())
+    {
+        connect(socket, &QLocalSocket::readyRead, this, &LayoutServer::readJobs);
+        connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+    }
+}
+
+void LayoutServer::readJobs()
+{
+    auto socket = qobject_cast<QLocalSocket*>(sender());
+    if(!socket)
+        return;
+
+    while(socket->canReadLine())
+    {
+        QJsonParseError err;
+        auto doc = QJsonDocument::fromJson(socket->readLine(), &err);
+        if(!doc.isObject()){
+            QJsonObject rv;
+            rv["error"] = err.errorString();
+            reply(socket, rv, QJsonValue(QJsonValue::Undefined), false);
+            continue;
+        }
+
+        const auto job = doc.object();
+        const auto id = job["id"];
+        std::shared_ptr<Layout> layout(new Layout);
+        QString error;
+        if(!Layout::fromJson(job, *layout, &error)){
+            QJsonObject rv;
+            rv["error"] = error;
+            reply(socket, rv, id, false);
+            continue;
+        }
+
+        const bool estimate = job["estimate"].toBool();
+        const bool dump = job["dump"].toBool();
+        // nazvy miestnosti su len vo vypise
+        QByteArray key = layout->hash(dump);
+        key += estimate ? ":e" : ":p";
+        if(dump)
+            key += "d";
+
+        if(auto result = cache.object(key)){
+            reply(socket, *result, id, true);
+            continue;
+        }
+
+        Waiting w;
+        w.socket = socket;
+        w.id = id;
+        bool running = pending.contains(key);
+        pending[key].append(w);
+        if(running)
+            continue;
+
+        ++started;
+        auto watcher = new QFutureWatcher<QJsonObject>(this);
+        connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, key](){
+            jobFinished(key, watcher->result());
+            watcher->deleteLater();
+        });
+        watcher->setFuture(QtConcurrent::run(&pool, &LayoutServer::runJob, layout, estimate, dump));
+    }
+}
+
+// bezi vo vlakne z pool, layout patri len tejto ulohe
+QJsonObject LayoutServer::runJob(std::shared_ptr<Layout> layout, bool estimate, bool dump)
+{
+    QJsonObject rv;
+    rv["hash"] = QString::fromLatin1(layout->hash(dump));
+    if(estimate){
+        rv["summary"] = layout->estimate().toJson();
+        return rv;
+    }
+
+    layout->build();
+    rv["summary"] = layout->summary().toJson();
+    rv["stats"] = layout->stats().toString();
+    if(dump){
+        QString text;
+        QTextStream out(&text);
+        layout->dump(out);
+        out.flush();
+        rv["dump"] = text;
+    }
+    return rv;
+}
+
+void LayoutServer::jobFinished(const QByteArray& key, const QJsonObject& result)
+{
+    cache.insert(key, new QJsonObject(result));
+    for(auto& w : pending.take(key))
+    {
+        if(w.socket)
+            reply(w.socket, result, w.id, false);
+    }
+}
+
+void LayoutServer::reply(QLocalSocket* socket, QJsonObject response,
+                         const QJsonValue& id, bool cached)
+{
+    if(!id.isUndefined())
+        response["id"] = id;
+    response["cached"] = cached;
+    socket->write(QJsonDocument(response).toJson(QJsonDocument::Compact) + '\n');
+}
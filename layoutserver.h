@@ -0,0 +1,56 @@
+#pragma once
+
+#include <QCache>
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QLocalServer>
+#include <QPointer>
+#include <QString>
+#include <QThreadPool>
+#include <memory>
+
+class QLocalSocket;
+class Layout;
+
+// Lokalny server pre opakovane kladenie planov. Klient posiela po riadkoch
+// JSON ulohy (plan podla Layout::fromJson, "estimate", "dump", "id").
+// Vysledky su v LRU cache podla Layout::hash(), s nazvami miestnosti len pre
+// "dump". Rovnaka uloha, ktora este bezi, sa nepocita druhy raz.
+class LayoutServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr const char* defaultName = "osb-dosky";
+
+    explicit LayoutServer(int cacheSize = 100, int jobs = 0, QObject *parent = 0);
+
+    bool listen(const QString& name);
+    QString errorString() const;
+    // ulohy poslane do pool, bez odpovedi z cache a bez cakajucich na rovnaku
+    int jobsStarted() const { return started; }
+
+private slots:
+    void newConnection();
+    void readJobs();
+
+private:
+    struct Waiting
+    {
+        QPointer<QLocalSocket> socket;
+        QJsonValue id;
+    };
+
+    static QJsonObject runJob(std::shared_ptr<Layout> layout, bool estimate, bool dump);
+    void jobFinished(const QByteArray& key, const QJsonObject& result);
+    static void reply(QLocalSocket* socket, QJsonObject response,
+                      const QJsonValue& id, bool cached);
+
+    QLocalServer server;
+    QString listenError;
+    int started = 0;
+    QThreadPool pool;
+    QCache<QByteArray, QJsonObject> cache;
+    QHash<QByteArray, QList<Waiting>> pending;
+};
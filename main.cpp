@@ -48,12 +48,16 @@
 **
 ****************************************************************************/
 
+#include "headless.h"
 #include "window.h"
 
 #include <QApplication>
 
 int main(int argc, char *argv[])
 {
+    if(isHeadless(argc, argv))
+        return runHeadless(argc, argv);
+
     QApplication app(argc, argv);
     Window window;
     window.showMaximized();
@@ -0,0 +1,521 @@
+#pragma once
+
+#include <QDebug>
+#include <QPainter>
+#include <QRectF>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "boardfacory.h"
+
+class PlacedBoard : public QRectF
+{
+    BoardPtr board;
+
+public:
+    enum class Dir {vertical, horizontal};
+
+    PlacedBoard(QPointF p, BoardPtr board, Dir dir, double takenLen = 0)
+        :QRectF(rect(p, board->len, board->width, dir))
+        ,board(std::move(board))
+        ,dir(dir)
+        ,taken(takenLen > 0 ? takenLen : this->board->len)
+    {
+    }
+
+    // obdlznik dosky polozenej z bodu p
+    static QRectF rect(QPointF p, double len, double width, Dir dir)
+    {
+        QSizeF size(len, width);
+        if(dir == PlacedBoard::Dir::vertical)
+        {
+            size.transpose();
+            p.setY(p.y() - size.height());
+        }
+        return QRectF(p, size);
+    }
+
+    BoardPtr takeBoard()
+    {
+        return std::move(board);
+    }
+
+    const Board& material() const
+    {
+        return *board;
+    }
+
+    // dlzka dosky zo skladu pred rucnym skratenim (BoardOverride::len)
+    double takenLen() const
+    {
+        return taken;
+    }
+
+    // bod, z ktoreho sa doska klada (ako start v Placer::placeRow)
+    QPointF origin() const
+    {
+        return dir == PlacedBoard::Dir::horizontal ? topLeft() : bottomLeft();
+    }
+
+    void draw(QPainter& painter) const
+    {
+        painter.drawRect(*this);
+    }
+
+    // bodkovane/ciarkovane oznacenie neodrezanych hran
+    void drawDecor(QPainter& painter) const
+    {
+        constexpr double dekorDist = 20;
+        if(width() < 2*dekorDist || height() < 2*dekorDist){
+            qDebug() << "uzky obdlznik " << static_cast<const QRectF*>(this);
+            return;
+        }
+
+        QPointF A(topLeft()+QPointF(dekorDist,dekorDist));
+        QPointF B(topRight()-QPointF(dekorDist,-dekorDist));
+        QPointF C(bottomRight()-QPointF(dekorDist,dekorDist));
+        QPointF D(bottomLeft()-QPointF(-dekorDist,dekorDist));
+
+        if(dir == PlacedBoard::Dir::vertical)
+        {
+            if(!board->cutH || !board->cutL){
+                painter.save();
+                QPen pen(painter.pen());
+                pen.setStyle(Qt::PenStyle::DotLine);
+                painter.setPen(pen);
+                if(!board->cutH)
+                    painter.drawLine(A,B);
+                if(!board->cutL)
+                    painter.drawLine(B,C);
+                painter.restore();
+            }
+            if(!board->cutT || !board->cutR){
+                painter.save();
+                QPen pen(painter.pen());
+                pen.setStyle(Qt::PenStyle::DashLine);
+                painter.setPen(pen);
+                if(!board->cutT)
+                    painter.drawLine(C,D);
+                if(!board->cutR)
+                    painter.drawLine(D,A);
+                painter.restore();
+            }
+        }
+        else
+        {
+            if(!board->cutH || !board->cutL){
+                painter.save();
+                QPen pen(painter.pen());
+                pen.setStyle(Qt::PenStyle::DotLine);
+                painter.setPen(pen);
+                if(!board->cutH)
+                    painter.drawLine(B,C);
+                if(!board->cutL)
+                    painter.drawLine(C,D);
+                painter.restore();
+            }
+            if(!board->cutT || !board->cutR){
+                painter.save();
+                QPen pen(painter.pen());
+                pen.setStyle(Qt::PenStyle::DashLine);
+                painter.setPen(pen);
+                if(!board->cutT)
+                    painter.drawLine(D,A);
+                if(!board->cutR)
+                    painter.drawLine(A,B);
+                painter.restore();
+            }
+        }
+    }
+
+private:
+    Dir dir;
+    double taken;
+};
+
+// rucna uprava jednej dosky, kluc je (riadok, cislo) ako v Placer::placeRow
+struct BoardOverride
+{
+    bool locked = false;     // doska drzi dlzku len a poziciu pos
+    QPointF pos;
+    double len = 0;          // 0 = dlzka podla skladu, inak sa doska skrati
+    double shift = 0;        // posun v smere kladenia
+    double offcutExtra = 0;  // predlzenie odrezku po zarezani do steny
+
+    bool isNull() const
+    {
+        return !locked && len == 0 && shift == 0 && offcutExtra == 0;
+    }
+
+    // prazdne upravy su rovnake, Layout ich neuklada
+    bool operator==(const BoardOverride& o) const
+    {
+        if(isNull() || o.isNull())
+            return isNull() && o.isNull();
+        return locked == o.locked && pos == o.pos && len == o.len &&
+                shift == o.shift && offcutExtra == o.offcutExtra;
+    }
+};
+
+using BoardOverrides = std::map<std::pair<int,int>, BoardOverride>;
+
+// steny, o ktore sa riadky zarezavaju
+struct PlaceLimits
+{
+    const QRectF* block = nullptr;
+    const QRectF* blockSide = nullptr;
+    const QRectF* dvere = nullptr;
+    const QRectF* blockDvere = nullptr;
+    double firtsLineCut = 0;
+};
+
+class Placer
+{
+    BoardFactory& boardFactory;
+    PlacedBoard::Dir dir;
+    qreal& (QPointF::*fw)() = &QPointF::rx;
+    qreal& (QPointF::*side)() = &QPointF::ry;
+    double factor = 1;
+    int allocs = 0;
+
+public:
+    Placer(PlacedBoard::Dir dir, BoardFactory& boardFactory)
+        :boardFactory(boardFactory)
+        ,dir(dir)
+    {
+        if(dir == PlacedBoard::Dir::vertical)
+        {
+            fw = &QPointF::ry;
+            side = &QPointF::rx;
+        }
+    }
+
+    using PlacedBoards = std::vector<std::unique_ptr<PlacedBoard>>;
+
+    // riadok ani miestnost, ktora nedosiahne stenu, nepokracuje donekonecna
+    static constexpr int maxBoards = 1000;  // dosiek v riadku
+    static constexpr int maxRows = 1000;    // riadkov v miestnosti
+
+    // pocet new Board a new PlacedBoard v tomto Placer
+    int allocations() const { return allocs; }
+
+    struct Row
+    {
+        PlacedBoards boards;
+        QPointF next;            // zaciatok dalsieho riadku
+        bool last = false;       // bocna stena dosiahnuta alebo dosli dosky
+        bool exhausted = false;
+        bool capped = false;     // maxBoards alebo maxRows
+    };
+
+    struct RowCount
+    {
+        QPointF next;
+        int pieces = 0;
+        bool last = false;
+        bool exhausted = false;
+        bool capped = false;
+    };
+
+    Row placeRow(QPointF start,
+                 int riadok,
+                 const PlaceLimits& limits,
+                 const BoardOverrides& overrides = BoardOverrides())
+    {
+        Row rv;
+        const bool firstLine = riadok == 1;
+        const double firtsLineCut = limits.firtsLineCut;
+
+        QPointF lineStart = start;
+        bool headSideReached = false;
+        int cislo = 1;
+        std::vector<BoardPtr> leftovers;
+        while(!headSideReached)
+        {
+            if(cislo > maxBoards){
+                qCritical() << "riadok" << riadok << "nedosiahol stenu";
+                pushLeftovers(leftovers);
+                rv.last = rv.capped = true;
+                return rv;
+            }
+
+            auto b = boardFactory.aquire();
+            if(!b){
+                qCritical() << "nie su dosky";
+                pushLeftovers(leftovers);
+                rv.last = rv.exhausted = true;
+                return rv;
+            }
+
+            auto it = overrides.find(std::make_pair(riadok, cislo));
+            const BoardOverride* ovr = it != overrides.end() ? &it->second : nullptr;
+            const double takenLen = b->len;
+            if(ovr){
+                applyOverride(*ovr, start, b, leftovers);
+            }
+
+            auto pb = newPlaced(start, std::move(b), takenLen);
+            bool blocked1 = limits.blockDvere && intersect(*limits.blockDvere, *pb) && limits.dvere && !intersect(*limits.dvere, *pb);
+            bool blocked = blocked1 || intersect(*limits.block, *pb);
+            auto tmpStart = start;
+            if( blocked1 ||   blocked ){
+                double cutlen = 0;
+                if(blocked1){
+                    cutlen = cut(*pb, *limits.blockDvere);
+                }
+                else{
+                    cutlen = cut(*pb, *limits.block);
+                }
+                auto b = takeBoard(pb);
+                auto bt = cutFw(*b, cutlen);
+                pb = newPlaced(start, std::move(bt), takenLen);
+                if(ovr){
+                    b->len += ovr->offcutExtra;
+                }
+                pushLeftovers(leftovers);
+                boardFactory.stackPush(std::move(b));
+                headSideReached = true;
+                start = lineStart + nextS(*pb);
+                if(firstLine && firtsLineCut > 0){
+                    start -= QPointF(firtsLineCut,0);
+                }
+            }
+            else{
+                start += nextP(*pb);
+            }
+
+            if(firstLine && firtsLineCut > 0)
+            {
+                auto b = takeBoard(pb);
+                auto bside = cutLeftSide(*b, firtsLineCut);
+                pb = newPlaced(tmpStart, std::move(b), takenLen);
+            }
+
+            qInfo() << riadok << cislo << *static_cast<const QRectF*>(pb);
+            rv.boards.emplace_back(pb);
+            ++cislo;
+        }
+
+        rv.next = start;
+        rv.last = intersectSide(*limits.blockSide, *rv.boards.back());
+        capRows(rv, riadok);
+        return rv;
+    }
+
+    // Ako placeRow, ale dosky len pocita. Cele dosky, ktore nesiahaju po ziadnu
+    // stenu, zoberie zo skladu naraz, jednotlivo kladie len dosky pri stene.
+    // Riadky s BoardOverride treba klast cez placeRow.
+    RowCount countRow(QPointF start,
+                      int riadok,
+                      const PlaceLimits& limits)
+    {
+        RowCount rv;
+        const bool firstLine = riadok == 1;
+        const double firtsLineCut = limits.firtsLineCut;
+        const Board full = boardFactory.fullBoard();
+
+        QPointF lineStart = start;
+        while(true)
+        {
+            int n = boardFactory.takeFull(std::min(freeBoards(start, full, limits),
+                                                   maxBoards - rv.pieces));
+            // po jednej doske ako v placeRow, n * len by sa zaokruhlilo inak
+            for(int i = 0; i < n; ++i)
+                start += nextP(full.len);
+            rv.pieces += n;
+
+            if(rv.pieces >= maxBoards){
+                qCritical() << "riadok" << riadok << "nedosiahol stenu";
+                rv.last = rv.capped = true;
+                return rv;
+            }
+
+            auto b = boardFactory.aquire();
+            if(!b){
+                qCritical() << "nie su dosky";
+                rv.last = rv.exhausted = true;
+                return rv;
+            }
+
+            auto r = PlacedBoard::rect(start, b->len, b->width, dir);
+            bool blocked1 = limits.blockDvere && intersect(*limits.blockDvere, r) && limits.dvere && !intersect(*limits.dvere, r);
+            bool blocked = blocked1 || intersect(*limits.block, r);
+            ++rv.pieces;
+            if(!blocked){
+                start += nextP(r);
+                continue;
+            }
+
+            double cutlen = blocked1 ? cut(r, *limits.blockDvere) : cut(r, *limits.block);
+            auto bt = cutFw(*b, cutlen);
+            r = PlacedBoard::rect(start, bt->len, bt->width, dir);
+            boardFactory.stackPush(std::move(b));
+            rv.next = lineStart + nextS(r);
+            if(firstLine && firtsLineCut > 0){
+                rv.next -= QPointF(firtsLineCut,0);
+                r = PlacedBoard::rect(start, bt->len, bt->width - firtsLineCut, dir);
+            }
+            rv.last = intersectSide(*limits.blockSide, r);
+            capRows(rv, riadok);
+            return rv;
+        }
+    }
+
+private:
+
+    // pocet dosiek dlzky b.len od start, ktore sa nedotknu ziadnej steny
+    int freeBoards(QPointF start, const Board& b, const PlaceLimits& limits) const
+    {
+        const bool horizontal = dir == PlacedBoard::Dir::horizontal;
+        auto first = PlacedBoard::rect(start, b.len, b.width, dir);
+        double pos = horizontal ? first.left() : -first.bottom();
+
+        double edge = std::numeric_limits<double>::max();
+        for(auto w : {limits.block, limits.blockDvere})
+        {
+            if(!w)
+                continue;
+            double sideOverlap = horizontal ?
+                        std::min(first.bottom(), w->bottom()) - std::max(first.top(), w->top()) :
+                        std::min(first.right(), w->right()) - std::max(first.left(), w->left());
+            double near = horizontal ? w->left() : -w->bottom();
+            double far = horizontal ? w->right() : -w->top();
+            if(sideOverlap > 0 && far > pos)
+                edge = std::min(edge, near);
+        }
+        if(edge == std::numeric_limits<double>::max() || edge <= pos)
+            return 0;
+
+        int n = int(std::floor((edge - pos) / b.len));
+        while(n > 0 && pos + n*b.len > edge)
+            --n;
+        return n;
+    }
+
+    template<typename R>
+    static void capRows(R& row, int riadok)
+    {
+        if(!row.last && riadok >= maxRows){
+            qCritical() << "miestnost nedosiahla bocnu stenu";
+            row.last = row.capped = true;
+        }
+    }
+
+    PlacedBoard* newPlaced(QPointF p, BoardPtr b, double takenLen = 0)
+    {
+        ++allocs;
+        return new PlacedBoard(p, std::move(b), dir, takenLen);
+    }
+
+    BoardPtr cutFw(Board& b, double cutlen)
+    {
+        ++allocs;
+        return b.cutFw(cutlen);
+    }
+
+    BoardPtr cutLeftSide(Board& b, double cutlen)
+    {
+        ++allocs;
+        return b.cutLeftSide(cutlen);
+    }
+
+    static BoardPtr takeBoard(PlacedBoard* pb)
+    {
+        auto b = pb->takeBoard();
+        delete pb;
+        return b;
+    }
+
+    // zvysok skratenej dosky ide do leftovers, nie hned do skladu, inak by
+    // ho aquire vydal ako dalsiu dosku toho isteho riadku
+    void applyOverride(const BoardOverride& ovr, QPointF& start, BoardPtr& b,
+                       std::vector<BoardPtr>& leftovers)
+    {
+        if(ovr.locked){
+            QPointF pos = ovr.pos;
+            (start.*fw)() = (pos.*fw)();
+        }
+        else{
+            start += ovr.shift * nextP(1);
+        }
+
+        if(ovr.len > 0 && ovr.len < b->len){
+            auto rest = cutFw(*b, b->len - ovr.len);
+            leftovers.push_back(std::move(b));
+            b = std::move(rest);
+        }
+    }
+
+    // po riadku, pod odrezok od steny, takze dalsi riadok zacina ako bez upravy
+    void pushLeftovers(std::vector<BoardPtr>& leftovers)
+    {
+        for(auto& b : leftovers)
+            boardFactory.stackPush(std::move(b));
+        leftovers.clear();
+    }
+
+    QPointF nextP(double len) const
+    {
+        return dir == PlacedBoard::Dir::horizontal ?
+            QPointF{len, 0} :
+            QPointF{0, -len};
+    }
+
+    QPointF nextP(const QRectF& b) const
+    {
+        return dir == PlacedBoard::Dir::horizontal ?
+            QPointF{b.width(), 0} :
+            QPointF{0, -b.height()};
+    }
+
+    QPointF nextS(const QRectF& b) const
+    {
+        return dir == PlacedBoard::Dir::horizontal ?
+            QPointF{0, b.height()} :
+            QPointF{b.width(), 0};
+    }
+
+    bool intersect(const QRectF& a, const QRectF& b) const
+    {
+        if(a.intersects(b)){
+            auto irect = a.intersected(b);
+            auto len = dir == PlacedBoard::Dir::horizontal ?
+                        irect.width() : irect.height();
+            return len > 0.1;
+        }
+        return false;
+    }
+
+    bool intersectSide(const QRectF& a, const QRectF& b) const
+    {
+        if(a.intersects(b)){
+            auto irect = a.intersected(b);
+            auto len = dir == PlacedBoard::Dir::horizontal ?
+                        irect.height() : irect.width();
+            return len > 0.1;
+        }
+        return false;
+    }
+
+    double cut(const QRectF& a, const QRectF& b) const
+    {
+        auto irect = a.intersected(b);
+        if(dir == PlacedBoard::Dir::horizontal){
+            return a.right()-irect.left();
+        }
+        else{
+            return irect.bottom() - a.top();
+        }
+    }
+
+    double cutSide(const QRectF& a, const QRectF& b) const
+    {
+        auto irect = a.intersected(b);
+        return dir == PlacedBoard::Dir::horizontal ?
+                        irect.height() : irect.width();
+    }
+};
@@ -54,7 +54,9 @@
 #include <QBrush>
 #include <QPen>
 #include <QPixmap>
+#include <QTimer>
 #include <QWidget>
+#include "layout.h"
 
 //! [0]
 class RenderArea : public QWidget
@@ -69,12 +71,23 @@ public:
 
 public slots:
 
+private slots:
+    void layoutStep();
+
 protected:
     void paintEvent(QPaintEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
 
 private:
+    void drawHud(QPainter& painter, const Layout::PaintStats& stats);
+
     QPen pen;
     QBrush brush;
+    Layout floorLayout;
+    Layout::BoardRef selected;
+    QTimer layoutTimer;
+    bool showHud = false;
 };
 //! [0]
 
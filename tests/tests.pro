@@ -0,0 +1,15 @@
+QT += testlib network concurrent
+CONFIG += c++11 testcase console
+CONFIG -= app_bundle
+
+TARGET = tst_layout
+INCLUDEPATH += ..
+DEFINES += GOLDEN_DIR=\\\"$$PWD/golden\\\"
+
+HEADERS       = ../boardfacory.h \
+                ../placer.h \
+                ../layout.h \
+                ../layoutserver.h
+SOURCES       = tst_layout.cpp \
+                ../layout.cpp \
+                ../layoutserver.cpp
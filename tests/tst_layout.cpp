@@ -0,0 +1,263 @@
+
+#include "layout.h"
+#include "layoutserver.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QLocalSocket>
+#include <QTextStream>
+#include <QtTest>
+
+// Kladenie referencneho planu a obdlznikovych miestnosti porovnane
+// s ulozenym vypisom golden/<plan>.txt. Po zamernej zmene v Placer alebo
+// BoardFactory sa vypis obnovi cez: basicdrawing --dump --plan <plan>
+// Spustenie z korena projektu: qmake && make check
+class TestLayout : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void golden_data();
+    void golden();
+    void fromJson_data();
+    void fromJson();
+    void resize_data();
+    void resize();
+    void hash();
+    void server();
+};
+
+void TestLayout::initTestCase()
+{
+    Layout::quietBoardLog();
+}
+
+void TestLayout::golden_data()
+{
+    QTest::addColumn<QString>("plan");
+    QTest::addColumn<qint64>("maxMs");
+
+    QTest::newRow("reference") << "reference" << qint64(200);
+    QTest::newRow("4000x3000h") << "4000x3000h" << qint64(200);
+    QTest::newRow("4000x3000v") << "4000x3000v" << qint64(200);
+    QTest::newRow("8000x6000h") << "8000x6000h" << qint64(200);
+    QTest::newRow("8000x6000v") << "8000x6000v" << qint64(200);
+    QTest::newRow("12345x2500v") << "12345x2500v" << qint64(200);
+    QTest::newRow("60000x8000h") << "60000x8000h" << qint64(1000);
+}
+
+void TestLayout::golden()
+{
+    QFETCH(QString, plan);
+    QFETCH(qint64, maxMs);
+
+    Layout layout;
+    QVERIFY(Layout::fromName(plan, layout));
+
+    QElapsedTimer timer;
+    timer.start();
+    layout.build();
+    auto ms = timer.elapsed();
+    QVERIFY2(ms <= maxMs, qPrintable(QString("layout took %1 ms, limit %2 ms").arg(ms).arg(maxMs)));
+
+    auto estimate = layout.estimate();
+    QVERIFY2(estimate == layout.summary(),
+             qPrintable("estimate " + estimate.toString() + ", placed " + layout.summary().toString()));
+
+    QString result;
+    QTextStream out(&result);
+    layout.dump(out);
+    out.flush();
+
+    QFile file(QString(GOLDEN_DIR "/%1.txt").arg(plan));
+    QVERIFY2(file.open(QIODevice::ReadOnly | QIODevice::Text), qPrintable("cannot open " + file.fileName()));
+    auto diff = Layout::compareDump(QString::fromUtf8(file.readAll()), result);
+    QVERIFY2(diff.isEmpty(), qPrintable(file.fileName() + ":" + diff));
+}
+
+// ulohy pre LayoutServer: zly sklad sa odmietne, plan bez steny skonci, odhad sedi aj pri necelych mm
+void TestLayout::fromJson_data()
+{
+    QTest::addColumn<QString>("json");
+    QTest::addColumn<bool>("valid");
+    QTest::addColumn<bool>("exhausted");
+    QTest::addColumn<bool>("capped");
+
+    QTest::newRow("stock 0") << "{\"plan\":\"8000x6000\",\"stock\":0}" << false << false << false;
+    QTest::newRow("stock -3") << "{\"plan\":\"8000x6000\",\"stock\":-3}" << false << false << false;
+    QTest::newRow("board 1500") << "{\"plan\":\"8000x6000\",\"board\":{\"len\":1500}}" << false << false << false;
+    QTest::newRow("reference board 200")
+            << "{\"plan\":\"reference\",\"board\":{\"width\":200}}" << false << false << false;
+    QTest::newRow("reference board 250")
+            << "{\"plan\":\"reference\",\"board\":{\"width\":250},\"stock\":300}" << true << false << false;
+    QTest::newRow("board 1600")
+            << "{\"plan\":\"8000x6000\",\"board\":{\"len\":1600}}" << true << false << false;
+    QTest::newRow("board 1600 stock 10")
+            << "{\"plan\":\"8000x6000\",\"board\":{\"len\":1600},\"stock\":10}" << true << true << false;
+    QTest::newRow("no walls")
+            << "{\"stock\":100000000,\"rooms\":[{\"name\":\"a\",\"start\":[0,0],"
+               "\"block\":[0,-9000,1,1],\"blockSide\":[0,-9000,1,1]}]}" << true << false << true;
+    QTest::newRow("no side wall")
+            << "{\"stock\":100000000,\"rooms\":[{\"name\":\"a\",\"start\":[0,0],"
+               "\"block\":[4000,0,200,1e9],\"blockSide\":[0,1e9,9,9]}]}" << true << false << true;
+    QTest::newRow("second room exhausted")
+            << "{\"stock\":20,\"rooms\":[{\"name\":\"a\",\"start\":[0,0],"
+               "\"block\":[4000,0,200,5000],\"blockSide\":[0,3000,9000,9000]},"
+               "{\"name\":\"b\",\"start\":[0,0],\"block\":[0,-9000,1,1],"
+               "\"blockSide\":[0,-9000,1,1]}]}" << true << true << false;
+    QTest::newRow("fractional")
+            << "{\"board\":{\"len\":2100.1},\"rooms\":[{\"name\":\"a\",\"start\":[0,0],"
+               "\"block\":[8000.3,0,200,1e6],\"blockSide\":[0,6000,1e6,1e6]}]}" << true << false << false;
+    QTest::newRow("fractional v")
+            << "{\"board\":{\"len\":2100.1,\"width\":625.7},\"rooms\":[{\"name\":\"a\",\"dir\":\"v\","
+               "\"start\":[0,6000.7],\"block\":[0,-200,1e6,200],\"blockSide\":[8000.3,0,200,1e6]}]}"
+            << true << false << false;
+}
+
+void TestLayout::fromJson()
+{
+    QFETCH(QString, json);
+    QFETCH(bool, valid);
+    QFETCH(bool, exhausted);
+    QFETCH(bool, capped);
+
+    Layout layout;
+    QString error;
+    auto doc = QJsonDocument::fromJson(json.toUtf8());
+    QVERIFY(doc.isObject());
+    QCOMPARE(Layout::fromJson(doc.object(), layout, &error), valid);
+    if(!valid)
+        return;
+
+    layout.build();
+    auto summary = layout.summary();
+    QCOMPARE(summary.exhausted, exhausted);
+    QCOMPARE(summary.capped, capped);
+    QVERIFY2(layout.estimate() == summary, qPrintable(summary.toString()));
+}
+
+static int rowSize(const Layout& layout, int room, int row)
+{
+    int rv = 0;
+    while(layout.board(Layout::BoardRef(room, row, rv)))
+        ++rv;
+    return rv;
+}
+
+// skratenie dosky klavesom - nikdy neprida do riadku dalsi kus
+void TestLayout::resize_data()
+{
+    QTest::addColumn<QString>("plan");
+
+    QTest::newRow("reference") << "reference";
+    QTest::newRow("8000x6000h") << "8000x6000h";
+    QTest::newRow("8000x6000v") << "8000x6000v";
+}
+
+void TestLayout::resize()
+{
+    QFETCH(QString, plan);
+
+    Layout layout;
+    QVERIFY(Layout::fromName(plan, layout));
+    layout.build();
+
+    for(int room = 0; layout.board(Layout::BoardRef(room, 0, 0)); ++room)
+    {
+        for(int row = 0; layout.board(Layout::BoardRef(room, row, 0)); ++row)
+        {
+            const int size = rowSize(layout, room, row);
+            for(int i = 0; i < size; ++i)
+            {
+                layout.resizeBoard(Layout::BoardRef(room, row, i), -10);
+                auto where = QString("room %1 row %2 board %3").arg(room).arg(row+1).arg(i+1);
+                QVERIFY2(rowSize(layout, room, row) <= size, qPrintable(where));
+                // doska pri stene sa neskracuje
+                QVERIFY2(layout.canUndo() == (i+1 < size), qPrintable(where));
+                if(layout.canUndo())
+                    layout.undo();
+            }
+        }
+    }
+}
+
+// kluc cache v LayoutServer nezavisi od nazvu miestnosti, vypis ano
+void TestLayout::hash()
+{
+    auto job = [](const QString& name, double len){
+        return QJsonDocument::fromJson(QString(
+            "{\"rooms\":[{\"name\":\"%1\",\"start\":[0,0],"
+            "\"block\":[%2,0,200,1e6],\"blockSide\":[0,3000,1e6,1e6]}]}")
+                .arg(name).arg(len).toUtf8()).object();
+    };
+
+    Layout a, b, c;
+    QVERIFY(Layout::fromJson(job("kuchyna", 4000), a));
+    QVERIFY(Layout::fromJson(job("spalna", 4000), b));
+    QVERIFY(Layout::fromJson(job("kuchyna", 4100), c));
+    QCOMPARE(a.hash(), b.hash());
+    QVERIFY(a.hash(true) != b.hash(true));
+    QVERIFY(a.hash() != c.hash());
+}
+
+// posle ulohy (JSON po riadkoch) a pocka na n odpovedi
+static QList<QJsonObject> submit(QLocalSocket& socket, const QByteArray& jobs, int n)
+{
+    QList<QJsonObject> rv;
+    socket.write(jobs);
+    while(rv.size() < n &&
+          QTest::qWaitFor([&socket](){ return socket.canReadLine(); }, 5000))
+    {
+        rv.append(QJsonDocument::fromJson(socket.readLine()).object());
+    }
+    return rv;
+}
+
+// LayoutServer v tom istom procese: cache, spojenie rovnakych uloh a LRU
+void TestLayout::server()
+{
+    const QString name = QString("tst_layout-%1").arg(QCoreApplication::applicationPid());
+    LayoutServer server(1);
+    QVERIFY2(server.listen(name), qPrintable(server.errorString()));
+    LayoutServer second;
+    QVERIFY(!second.listen(name));
+
+    QLocalSocket socket;
+    socket.connectToServer(name);
+    QVERIFY(socket.waitForConnected(3000));
+
+    const QByteArray a = "{\"plan\":\"8000x6000\",\"dump\":true}\n";
+    const QByteArray b = "{\"plan\":\"4000x3000\"}\n";
+
+    // druha rovnaka uloha caka na vysledok prvej
+    const auto first = submit(socket, a + a, 2);
+    QCOMPARE(first.size(), 2);
+    QCOMPARE(server.jobsStarted(), 1);
+    QVERIFY(!first[0]["cached"].toBool());
+    QVERIFY(first[0].contains("dump"));
+    QCOMPARE(first[1]["hash"], first[0]["hash"]);
+    QCOMPARE(first[1]["summary"], first[0]["summary"]);
+
+    const auto again = submit(socket, a, 1);
+    QCOMPARE(again.size(), 1);
+    QVERIFY(again[0]["cached"].toBool());
+    QCOMPARE(again[0]["hash"], first[0]["hash"]);
+    QCOMPARE(again[0]["summary"], first[0]["summary"]);
+    QCOMPARE(server.jobsStarted(), 1);
+
+    // cache ma jedno miesto, b vytlaci a
+    QCOMPARE(submit(socket, b, 1).size(), 1);
+    const auto evicted = submit(socket, a, 1);
+    QCOMPARE(evicted.size(), 1);
+    QVERIFY(!evicted[0]["cached"].toBool());
+    QCOMPARE(evicted[0]["summary"], first[0]["summary"]);
+    QCOMPARE(server.jobsStarted(), 3);
+
+    const auto bad = submit(socket, "{\"plan\":\"nic\"}\n", 1);
+    QCOMPARE(bad.size(), 1);
+    QVERIFY(bad[0].contains("error"));
+}
+
+QTEST_GUILESS_MAIN(TestLayout)
+#include "tst_layout.moc"